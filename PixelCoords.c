@@ -11,13 +11,17 @@
 
 #include "PixelCoords.h"
 
+#include <assert.h>
 #include <inttypes.h>
 #include <stdio.h>
 
 PixelCoords PixelCoordsCreate(int u, int v) {
+  assert(0 <= u && u <= PIXELCOORDS_MAX);
+  assert(0 <= v && v <= PIXELCOORDS_MAX);
+
   PixelCoords p;
-  p.u = u;
-  p.v = v;
+  p.u = (uint16_t)u;
+  p.v = (uint16_t)v;
 
   return p;
 }
@@ -14,13 +14,19 @@
 
 #include <inttypes.h>
 
+/// Coordinates are packed as two 16-bit fields (4 bytes per pixel),
+/// so images used with this ADT must be at most 65535 pixels on a side.
+/// This halves the memory and bandwidth of the Stack and Queue work-lists.
+#define PIXELCOORDS_MAX 65535
+
 struct _PixelCoords {
-  int u;
-  int v;
+  uint16_t u;
+  uint16_t v;
 };
 
 typedef struct _PixelCoords PixelCoords;
 
+/// Requires 0 <= u, v <= PIXELCOORDS_MAX.
 PixelCoords PixelCoordsCreate(int u, int v);
 
 int PixelCoordsGetU(PixelCoords p);
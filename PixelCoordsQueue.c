@@ -15,114 +15,146 @@
 #include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <string.h>
 
 #include "PixelCoords.h"
 
+// The queue is stored in a linked list of fixed-size chunks: elements are
+// enqueued in the last chunk and dequeued from the first one, so the
+// queue grows and shrinks without ever reallocating (and copying) its
+// contents. Each chunk is a ring buffer with a power-of-two size, indexed
+// with free-running head and tail counters and a mask; while the queue
+// fits in a single chunk, it simply cycles through it.
+// Emptied chunks are kept in a small cache, to be reused without malloc.
+
+#define QUEUE_CHUNK_SIZE 1024  // elements per chunk (a power of 2)
+#define QUEUE_CHUNK_MASK (QUEUE_CHUNK_SIZE - 1)
+#define QUEUE_FREE_CHUNKS 4    // maximum number of cached free chunks
+
+struct queueChunk {
+  struct queueChunk* next;  // the chunk enqueued after this one
+  uint32_t head;            // counter of dequeued elements
+  uint32_t tail;            // counter of enqueued elements
+  PixelCoords data[QUEUE_CHUNK_SIZE];
+};
+
 struct _PixelCoordsQueue {
-  uint32_t max_size;  // maximum Queue size
-  uint32_t cur_size;  // current Queue size
-  uint32_t head;
-  uint32_t tail;
-  PixelCoords* data;  // the data (PixelCoords instances stored in an array)
+  uint32_t cur_size;         // current Queue size
+  struct queueChunk* first;  // the chunk to dequeue from
+  struct queueChunk* last;   // the chunk to enqueue into
+  struct queueChunk* free;   // cached free chunks (linked by next)
+  uint32_t num_free;         // number of cached free chunks
 };
 
-// PRIVATE auxiliary function
+// PRIVATE auxiliary functions
 
-static uint32_t increment_index(const Queue* q, uint32_t i) {
-  return (i + 1 < q->max_size) ? i + 1 : 0;
+static struct queueChunk* take_chunk(Queue* q) {
+  struct queueChunk* c = q->free;
+  if (c != NULL) {
+    q->free = c->next;
+    q->num_free--;
+  } else {
+    c = malloc(sizeof(struct queueChunk));
+    if (c == NULL) abort();
+  }
+  c->next = NULL;
+  c->head = c->tail = 0;
+  return c;
+}
+
+static void release_chunk(Queue* q, struct queueChunk* c) {
+  if (q->num_free < QUEUE_FREE_CHUNKS) {
+    c->next = q->free;
+    q->free = c;
+    q->num_free++;
+  } else {
+    free(c);
+  }
 }
 
 // PUBLIC functions
 
 Queue* QueueCreate(uint32_t size) {
   assert(size > 1);
+  (void)size;  // only checked: the chunks have a fixed size
   Queue* q = malloc(sizeof(Queue));
   if (q == NULL) abort();
 
-  q->max_size = size;
   q->cur_size = 0;
+  q->free = NULL;
+  q->num_free = 0;
 
-  q->head = 1;  // cur_size = tail - head + 1
-  q->tail = 0;
-
-  q->data = malloc(size * sizeof(PixelCoords));
-  if (q->data == NULL) {
+  q->first = malloc(sizeof(struct queueChunk));
+  if (q->first == NULL) {
     free(q);
     abort();
   }
+  q->first->next = NULL;
+  q->first->head = q->first->tail = 0;
+  q->last = q->first;
   return q;
 }
 
 void QueueDestroy(Queue** p) {
   assert(*p != NULL);
   Queue* q = *p;
-  free(q->data);
+  QueueClear(q);
+  free(q->first);
+  while (q->free != NULL) {
+    struct queueChunk* c = q->free;
+    q->free = c->next;
+    free(c);
+  }
   free(q);
   *p = NULL;
 }
 
 void QueueClear(Queue* q) {
+  while (q->first != q->last) {
+    struct queueChunk* c = q->first;
+    q->first = c->next;
+    release_chunk(q, c);
+  }
+  q->first->head = q->first->tail = 0;
   q->cur_size = 0;
-  q->head = 1;  // cur_size = tail - head + 1
-  q->tail = 0;
 }
 
 uint32_t QueueSize(const Queue* q) { return q->cur_size; }
 
-int QueueIsFull(const Queue* q) { return (q->cur_size == q->max_size); }
+int QueueIsFull(const Queue* q) {
+  (void)q;
+  return 0;  // a new chunk is added when needed
+}
 
 int QueueIsEmpty(const Queue* q) { return (q->cur_size == 0); }
 
 PixelCoords QueuePeek(const Queue* q) {
   assert(q->cur_size > 0);
-  return q->data[q->head];
+  return q->first->data[q->first->head & QUEUE_CHUNK_MASK];
 }
 
 void QueueEnqueue(Queue* q, PixelCoords p) {
-  assert(q->cur_size <= q->max_size);
-
-  // Is the queue full?
-  if (q->cur_size == q->max_size) {
-    PixelCoords* old = q->data;  // The current queue array that is full
-
-    q->max_size *= 10;
-    q->data = (PixelCoords*)malloc(q->max_size * sizeof(PixelCoords));
-    if (q->data == NULL) {
-      free(q);
-      free(old);
-      abort();
-    }
-
-    // Copying to the new queue array
-    // 1st block of queue elements
-    uint32_t size_block_1 = q->cur_size - q->head;
-    // Using pointer arithmetic
-    memcpy(q->data, (old + q->head), size_block_1 * sizeof(PixelCoords));
-    if (size_block_1 != q->cur_size) {
-      // 2nd block of queue elements
-      uint32_t size_block_2 = q->cur_size - size_block_1;
-      // Using pointer arithmetic
-      memcpy((q->data + size_block_1), old, size_block_2 * sizeof(PixelCoords));
-    }
-
-    // Freeing the old array
-    free(old);
-
-    // Resetting the head and tail indices
-    q->head = 0;
-    q->tail = q->cur_size - 1;
+  struct queueChunk* c = q->last;
+
+  // Is the last chunk full?
+  if (c->tail - c->head == QUEUE_CHUNK_SIZE) {
+    c->next = take_chunk(q);
+    c = q->last = c->next;
   }
 
-  q->tail = increment_index(q, q->tail);
-  q->data[q->tail] = p;
+  c->data[c->tail++ & QUEUE_CHUNK_MASK] = p;
   q->cur_size++;
 }
 
 PixelCoords QueueDequeue(Queue* q) {
   assert(q->cur_size > 0);
-  int old_head = q->head;
-  q->head = increment_index(q, q->head);
+  struct queueChunk* c = q->first;
+  PixelCoords p = c->data[c->head++ & QUEUE_CHUNK_MASK];
   q->cur_size--;
-  return q->data[old_head];
+
+  // An emptied chunk is released, unless it is the only one
+  if (c->head == c->tail && c != q->last) {
+    q->first = c->next;
+    release_chunk(q, c);
+  }
+  return p;
 }
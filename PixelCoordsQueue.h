@@ -18,6 +18,8 @@
 
 typedef struct _PixelCoordsQueue Queue;
 
+// The queue grows and shrinks on demand, in fixed-size chunks,
+// so it is never full; size must be > 1 but is otherwise ignored.
 Queue* QueueCreate(uint32_t size);
 
 void QueueDestroy(Queue** p);
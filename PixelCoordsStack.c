@@ -17,66 +17,136 @@
 
 #include "PixelCoords.h"
 
+// The stack is stored in a linked list of fixed-size chunks, so it grows
+// and shrinks without ever reallocating (and copying) its contents.
+// Emptied chunks are kept in a small cache, to be reused without malloc
+// when the stack grows again.
+
+#define STACK_CHUNK_SIZE 1024  // elements per chunk
+#define STACK_FREE_CHUNKS 4    // maximum number of cached free chunks
+
+struct stackChunk {
+  struct stackChunk* prev;  // the chunk below (NULL for the first)
+  PixelCoords data[STACK_CHUNK_SIZE];
+};
+
 struct _PixelCoordsStack {
-  uint32_t max_size;  // maximum stack size
-  uint32_t cur_size;  // current stack size
-  PixelCoords* data;  // the stack data (stored in an array)
+  uint32_t cur_size;            // current stack size
+  uint32_t top;                 // number of elements in the top chunk
+  struct stackChunk* chunk;     // the top chunk
+  struct stackChunk* free;      // cached free chunks (linked by prev)
+  uint32_t num_free;            // number of cached free chunks
 };
 
+// PRIVATE auxiliary functions
+
+static struct stackChunk* take_chunk(Stack* s) {
+  struct stackChunk* c = s->free;
+  if (c != NULL) {
+    s->free = c->prev;
+    s->num_free--;
+    return c;
+  }
+  c = malloc(sizeof(struct stackChunk));
+  if (c == NULL) abort();
+  return c;
+}
+
+static void release_chunk(Stack* s, struct stackChunk* c) {
+  if (s->num_free < STACK_FREE_CHUNKS) {
+    c->prev = s->free;
+    s->free = c;
+    s->num_free++;
+  } else {
+    free(c);
+  }
+}
+
+// PUBLIC functions
+
 Stack* StackCreate(uint32_t size) {
   assert(size > 1);
+  (void)size;  // only checked: the chunks have a fixed size
   Stack* s = malloc(sizeof(Stack));
   if (s == NULL) abort();
 
-  s->max_size = size;
   s->cur_size = 0;
+  s->top = 0;
+  s->free = NULL;
+  s->num_free = 0;
 
-  s->data = malloc(size * sizeof(PixelCoords));
-  if (s->data == NULL) {
+  s->chunk = malloc(sizeof(struct stackChunk));
+  if (s->chunk == NULL) {
     free(s);
     abort();
   }
+  s->chunk->prev = NULL;
   return s;
 }
 
 void StackDestroy(Stack** p) {
   assert(*p != NULL);
   Stack* s = *p;
-  free(s->data);
+  StackClear(s);
+  free(s->chunk);
+  while (s->free != NULL) {
+    struct stackChunk* c = s->free;
+    s->free = c->prev;
+    free(c);
+  }
   free(s);
   *p = NULL;
 }
 
-void StackClear(Stack* s) { s->cur_size = 0; }
+void StackClear(Stack* s) {
+  while (s->chunk->prev != NULL) {
+    struct stackChunk* c = s->chunk;
+    s->chunk = c->prev;
+    release_chunk(s, c);
+  }
+  s->top = 0;
+  s->cur_size = 0;
+}
 
 uint32_t StackSize(const Stack* s) { return s->cur_size; }
 
-int StackIsFull(const Stack* s) { return (s->cur_size == s->max_size); }
+int StackIsFull(const Stack* s) {
+  (void)s;
+  return 0;  // a new chunk is added when needed
+}
 
 int StackIsEmpty(const Stack* s) { return (s->cur_size == 0); }
 
 PixelCoords StackPeek(const Stack* s) {
   assert(s->cur_size > 0);
-  return s->data[s->cur_size - 1];
+  if (s->top == 0) return s->chunk->prev->data[STACK_CHUNK_SIZE - 1];
+  return s->chunk->data[s->top - 1];
 }
 
 void StackPush(Stack* s, PixelCoords p) {
-  assert(s->cur_size <= s->max_size);
-
-  // Is the stack full?
-  if (s->cur_size == s->max_size) {
-    s->max_size *= 2;
-    s->data = (PixelCoords*)realloc(s->data, s->max_size * sizeof(PixelCoords));
-    if (s->data == NULL) {
-      free(s);
-      abort();
-    }
+  // Is the top chunk full?
+  if (s->top == STACK_CHUNK_SIZE) {
+    struct stackChunk* c = take_chunk(s);
+    c->prev = s->chunk;
+    s->chunk = c;
+    s->top = 0;
   }
 
-  s->data[s->cur_size++] = p;
+  s->chunk->data[s->top++] = p;
+  s->cur_size++;
 }
 
 PixelCoords StackPop(Stack* s) {
   assert(s->cur_size > 0);
-  return s->data[--(s->cur_size)];
+
+  // Is the top chunk empty? Then continue in the chunk below.
+  if (s->top == 0) {
+    struct stackChunk* c = s->chunk;
+    s->chunk = c->prev;
+    release_chunk(s, c);
+    s->top = STACK_CHUNK_SIZE;
+  }
+
+  s->cur_size--;
+  return s->chunk->data[--(s->top)];
 }
@@ -18,6 +18,8 @@
 
 typedef struct _PixelCoordsStack Stack;
 
+// The stack grows and shrinks on demand, in fixed-size chunks,
+// so it is never full; size must be > 1 but is otherwise ignored.
 Stack* StackCreate(uint32_t size);
 
 void StackDestroy(Stack** p);